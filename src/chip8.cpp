@@ -27,7 +27,7 @@ const std::array<std::uint8_t, 80> Chip8::font_data = {
 const std::uint8_t Chip8::view_width;   // Internal graphics width
 const std::uint8_t Chip8::view_height;  // Internal graphics height
 
-Chip8::Chip8(const char* game) : PC{program_start}, I{0}, SP{0}, DT{0}, ST{0}, opcode{0} {
+Chip8::Chip8() : PC{program_start}, I{0}, SP{0}, DT{0}, ST{0}, rng{}, opcode{0} {
     // Clear input and graphics
     keypad.fill(0);
     framebuffer.fill(0);
@@ -40,17 +40,26 @@ Chip8::Chip8(const char* game) : PC{program_start}, I{0}, SP{0}, DT{0}, ST{0}, o
     // Load font data into start of memory
     for (int i = 0; i < font_data.size(); ++i) { memory[i] = font_data[i]; }
 
+    // Seed from the clock by default, callers wanting reproducible runs can reseed
+    seed(std::time(0));
+}
+
+Chip8::Chip8(const char* game) : Chip8() {
+    if (!load(game)) { std::exit(1); }
+}
+
+bool Chip8::load(const char* game) {
     // Open game file
     std::ifstream file(game, std::ios::in | std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         std::cerr << "Could not open game file: " << game << std::endl;
-        std::exit(1);
+        return false;
     }
 
     // Check that file will fit in available memory
     if (file.tellg() > (memory.size() - program_start)) {
         std::cerr << "Game file is too large: " << game << std::endl;
-        std::exit(1);
+        return false;
     }
 
     // Load game into start of program memory
@@ -60,11 +69,16 @@ Chip8::Chip8(const char* game) : PC{program_start}, I{0}, SP{0}, DT{0}, ST{0}, o
     while (file >> std::noskipws >> byte) { memory[program_start + i++] = byte; }
     file.close();
 
-    // Pre-C++11 style randomness
-    std::srand(std::time(0));
+    return true;
 }
 
-void Chip8::emulate_cycle() {
+bool Chip8::emulate_cycle() {
+    // Stop a runaway program counter before it reads past the end of memory
+    if (!fits(PC, 2)) {
+        std::cerr << "Program counter out of range: 0x" << std::hex << PC << std::endl;
+        return false;
+    }
+
     // Get current opcode
     opcode = memory[PC] << 8 | memory[PC + 1];
 
@@ -80,6 +94,10 @@ void Chip8::emulate_cycle() {
 
                 // 00EE - RET - Return from a subroutine
                 case 0x00EE: {
+                    if (SP == 0) {
+                        std::cerr << "Stack underflow at 0x" << std::hex << PC << std::endl;
+                        return false;
+                    }
                     PC = stack[--SP];
                     PC += 2;
                     break;
@@ -87,7 +105,7 @@ void Chip8::emulate_cycle() {
 
                 default: {
                     std::cerr << "Unsupported opcode: 0x" << std::hex << opcode << std::endl;
-                    std::exit(1);
+                    return false;
                 }
             }
             break;
@@ -101,6 +119,10 @@ void Chip8::emulate_cycle() {
 
         // 2NNN - CALL addr - Call subroutine at NNN
         case 0x2000: {
+            if (SP == stack.size()) {
+                std::cerr << "Stack overflow at 0x" << std::hex << PC << std::endl;
+                return false;
+            }
             stack[SP++] = PC;
             PC = NNN();
             break;
@@ -234,7 +256,7 @@ void Chip8::emulate_cycle() {
 
                 default: {
                     std::cerr << "Unsupported opcode: 0x" << std::hex << opcode << std::endl;
-                    std::exit(1);
+                    return false;
                 }
             }
             break;
@@ -265,7 +287,7 @@ void Chip8::emulate_cycle() {
 
         // CXKK - RND VX, byte - Set VX = random byte AND KK
         case 0xC000: {
-            V[X()] = (std::rand() % 0xFF) & KK();
+            V[X()] = (rng() % 0xFF) & KK();
             PC += 2;
             break;
         }
@@ -276,6 +298,7 @@ void Chip8::emulate_cycle() {
             auto x = V[X()];
             auto y = V[Y()];
             auto height = opcode & 0x000F;
+            if (!fits(I, height)) { return address_error(); }
 
             // Clear carry register
             V[0xF] = 0;
@@ -311,6 +334,10 @@ void Chip8::emulate_cycle() {
             switch (opcode & 0x00FF) {
                 // EX9E - SKP VX - Skip next instruction if key with the value of VX is pressed
                 case 0x009E: {
+                    if (V[X()] >= keypad.size()) {
+                        std::cerr << "Invalid key: 0x" << std::hex << +V[X()] << std::endl;
+                        return false;
+                    }
                     if (keypad[V[X()]]) {
                         PC += 4;
                     } else {
@@ -321,6 +348,10 @@ void Chip8::emulate_cycle() {
 
                 // EXA1 - SKNP VX - Skip the next instruction if key with the value VX is not pressed
                 case 0x00A1: {
+                    if (V[X()] >= keypad.size()) {
+                        std::cerr << "Invalid key: 0x" << std::hex << +V[X()] << std::endl;
+                        return false;
+                    }
                     if (!keypad[V[X()]]) {
                         PC += 4;
                     } else {
@@ -331,7 +362,7 @@ void Chip8::emulate_cycle() {
 
                 default: {
                     std::cerr << "Unsupported opcode: 0x" << std::hex << opcode << std::endl;
-                    std::exit(1);
+                    return false;
                 }
             }
             break;
@@ -393,6 +424,7 @@ void Chip8::emulate_cycle() {
 
                 // FX33 - LD B, VX - Store BCD representation of VX in memory location I, I + 1, and I + 2
                 case 0x033: {
+                    if (!fits(I, 3)) { return address_error(); }
                     const auto vx = V[X()];
                     memory[I] = vx / 100;             // Isolate hundreds
                     memory[I + 1] = (vx % 100) / 10;  // Isolate tens
@@ -404,6 +436,7 @@ void Chip8::emulate_cycle() {
                 // FX55 - LD [I], VX - Store V0 to VX in memory starting at address I
                 // Conflicting tech specs on whether I itself should be incremented at each step
                 case 0x055: {
+                    if (!fits(I, X() + 1)) { return address_error(); }
                     for (int i = 0; i <= X(); ++i) {
                         // memory[I++] = V[i];
                         memory[I + i] = V[i];
@@ -415,6 +448,7 @@ void Chip8::emulate_cycle() {
                 // FX65 - LD VX, [I] - Fills V0 to VX with values from memory starting at address I
                 // Conflicting tech specs on whether I itself should be incremented at each step
                 case 0x065: {
+                    if (!fits(I, X() + 1)) { return address_error(); }
                     for (int i = 0; i <= X(); ++i) {
                         // V[i] = memory[I++];
                         V[i] = memory[I + i];
@@ -425,7 +459,7 @@ void Chip8::emulate_cycle() {
 
                 default: {
                     std::cerr << "Unsupported opcode: 0x" << std::hex << opcode << std::endl;
-                    std::exit(1);
+                    return false;
                 }
             }
             break;
@@ -433,9 +467,16 @@ void Chip8::emulate_cycle() {
 
         default: {
             std::cerr << "Unsupported opcode: 0x" << std::hex << opcode << std::endl;
-            std::exit(1);
+            return false;
         }
     }
+
+    return true;
+}
+
+bool Chip8::address_error() const {
+    std::cerr << "Address register out of range: 0x" << std::hex << I << std::endl;
+    return false;
 }
 
 void Chip8::decrement_timers() {
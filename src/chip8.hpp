@@ -3,12 +3,19 @@
 
 #include <array>
 #include <cstdint>
+#include <random>
 #include <utility>
 
 class Chip8 {
 public:
+    Chip8();
     Chip8(const char* game);
 
+    // Load game into program memory, returning false if it could not be loaded
+    bool load(const char* game);
+    // Reseed the random number generator used by CXKK
+    inline void seed(std::uint32_t value) { rng.seed(value); }
+
     // Return internal view dimensions for platform window
     static inline auto get_view_dimensions() { return std::make_pair(view_width, view_height); }
     // Return writable keypad for platform input
@@ -17,8 +24,23 @@ public:
     inline auto get_pixels() const { return framebuffer.data(); }
     // Return sound timer for platform audio
     inline auto get_sound_timer() const { return ST; }
+    // Return read-only memory for external inspection
+    inline const auto& get_memory() const { return memory; }
+    // Return program counter for external inspection
+    inline auto get_program_counter() const { return PC; }
+    // Return general purpose registers for external inspection
+    inline const auto& get_registers() const { return V; }
+    // Return address register for external inspection
+    inline auto get_address_register() const { return I; }
+    // Return subroutine stack and stack pointer for external inspection
+    inline const auto& get_stack() const { return stack; }
+    inline auto get_stack_pointer() const { return SP; }
+    // Return delay timer for external inspection
+    inline auto get_delay_timer() const { return DT; }
 
-    void emulate_cycle();
+    // Returns false if the current opcode is unsupported or would access out of range memory or
+    // stack, leaving state unchanged since emulation cannot continue
+    bool emulate_cycle();
     void decrement_timers();
 
 private:
@@ -40,12 +62,20 @@ private:
     std::uint8_t DT;   // Delay timer
     std::uint8_t ST;   // Sound timer
 
+    std::minstd_rand rng;  // Random source, kept per instance so state can be copied and reseeded
+
     // Current opcode and helpers
     std::uint16_t opcode;
     inline std::uint8_t X() const { return (opcode & 0x0F00) >> 8; }
     inline std::uint8_t Y() const { return (opcode & 0x00F0) >> 4; }
     inline std::uint8_t KK() const { return opcode & 0x00FF; }
     inline std::uint16_t NNN() const { return opcode & 0x0FFF; }
+
+    // Bounds checks for untrusted programs, out of range accesses halt emulation
+    inline bool fits(std::uint32_t address, std::uint32_t length) const {
+        return address + length <= memory.size();
+    }
+    bool address_error() const;
 };
 
 #endif  // CHIP_8
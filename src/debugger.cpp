@@ -0,0 +1,540 @@
+#include "debugger.hpp"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+volatile std::sig_atomic_t interrupted = 0;  // Set by Ctrl-C to break into the debugger
+
+void interrupt(int) { interrupted = 1; }
+
+std::string hex(unsigned value, int width) {
+    std::ostringstream stream;
+    stream << std::uppercase << std::hex << std::setw(width) << std::setfill('0') << value;
+    return stream.str();
+}
+
+// Parse a hexadecimal number, with or without a 0x prefix
+bool parse_hex(const std::string& token, std::uint16_t& value) {
+    if (token.empty()) { return false; }
+    char* end;
+    const auto parsed = std::strtoul(token.c_str(), &end, 16);
+    if (*end || parsed > 0xFFFF) { return false; }
+    value = parsed;
+    return true;
+}
+
+std::string disassemble(std::uint16_t opcode) {
+    const auto x = "V" + hex((opcode & 0x0F00) >> 8, 1);
+    const auto y = "V" + hex((opcode & 0x00F0) >> 4, 1);
+    const auto kk = "0x" + hex(opcode & 0x00FF, 2);
+    const auto nnn = "0x" + hex(opcode & 0x0FFF, 3);
+    const auto n = std::to_string(opcode & 0x000F);
+
+    switch (opcode & 0xF000) {
+        case 0x0000: {
+            if (opcode == 0x00E0) { return "CLS"; }
+            if (opcode == 0x00EE) { return "RET"; }
+            break;
+        }
+        case 0x1000: return "JP " + nnn;
+        case 0x2000: return "CALL " + nnn;
+        case 0x3000: return "SE " + x + ", " + kk;
+        case 0x4000: return "SNE " + x + ", " + kk;
+        case 0x5000: return "SE " + x + ", " + y;
+        case 0x6000: return "LD " + x + ", " + kk;
+        case 0x7000: return "ADD " + x + ", " + kk;
+        case 0x8000: {
+            switch (opcode & 0x000F) {
+                case 0x0000: return "LD " + x + ", " + y;
+                case 0x0001: return "OR " + x + ", " + y;
+                case 0x0002: return "AND " + x + ", " + y;
+                case 0x0003: return "XOR " + x + ", " + y;
+                case 0x0004: return "ADD " + x + ", " + y;
+                case 0x0005: return "SUB " + x + ", " + y;
+                case 0x0006: return "SHR " + x;
+                case 0x0007: return "SUBN " + x + ", " + y;
+                case 0x000E: return "SHL " + x;
+            }
+            break;
+        }
+        case 0x9000: return "SNE " + x + ", " + y;
+        case 0xA000: return "LD I, " + nnn;
+        case 0xB000: return "JP V0, " + nnn;
+        case 0xC000: return "RND " + x + ", " + kk;
+        case 0xD000: return "DRW " + x + ", " + y + ", " + n;
+        case 0xE000: {
+            if ((opcode & 0x00FF) == 0x009E) { return "SKP " + x; }
+            if ((opcode & 0x00FF) == 0x00A1) { return "SKNP " + x; }
+            break;
+        }
+        case 0xF000: {
+            switch (opcode & 0x00FF) {
+                case 0x0007: return "LD " + x + ", DT";
+                case 0x000A: return "LD " + x + ", K";
+                case 0x0015: return "LD DT, " + x;
+                case 0x0018: return "LD ST, " + x;
+                case 0x001E: return "ADD I, " + x;
+                case 0x0029: return "LD F, " + x;
+                case 0x0033: return "LD B, " + x;
+                case 0x0055: return "LD [I], " + x;
+                case 0x0065: return "LD " + x + ", [I]";
+            }
+            break;
+        }
+    }
+
+    return "DW 0x" + hex(opcode, 4);
+}
+
+const char* help =
+    "Addresses and values are hexadecimal\n"
+    "  c, continue         Resume until something breaks\n"
+    "  s, step [COUNT]     Execute COUNT instructions\n"
+    "  n, next             Step, running through CALL until it returns\n"
+    "  f, finish           Run until the current subroutine returns\n"
+    "  b ADDR              Toggle a breakpoint at ADDR\n"
+    "  w ADDR [LENGTH]     Toggle watchpoints on writes to ADDR onwards\n"
+    "  cond REG OP VALUE   Break when e.g. V3 == 10 becomes true\n"
+    "                      REG is one of V0-VF, I, PC, SP, DT or ST\n"
+    "  clear               Remove all breakpoints, watchpoints and conditions\n"
+    "  i, info             List breakpoints, watchpoints and conditions\n"
+    "  r, regs             Show registers and stack\n"
+    "  l, list [ADDR]      Disassemble around ADDR, defaulting to PC\n"
+    "  x ADDR [LENGTH]     Dump memory\n"
+    "  q, quit             Exit the emulator\n";
+
+}  // namespace
+
+Debugger::Debugger(Chip8& chip8, int cycles_per_tick)
+    : chip8{chip8},
+      cycles_per_tick{cycles_per_tick},
+      cycles_until_tick{cycles_per_tick},
+      paused{true},
+      halted{false},
+      steps{0},
+      return_depth{-1},
+      return_pc{0},
+      input_closed{false},
+      prompted{false} {
+    previous_handler = std::signal(SIGINT, interrupt);
+    std::cout << "Debugger attached, type h for help" << std::endl;
+    stop();
+}
+
+Debugger::~Debugger() { std::signal(SIGINT, previous_handler); }
+
+bool Debugger::run(int cycles) {
+    // Pauses return to the main loop so the window is rendered and its events are handled, the
+    // prompt is shown at the start of the next frame
+    auto resumed = false;
+    if (paused) {
+        switch (prompt()) {
+            case Action::Stay: {
+                return true;
+            }
+
+            case Action::Resume: {
+                paused = false;
+                resumed = true;
+                break;
+            }
+
+            case Action::Quit: {
+                return false;
+            }
+        }
+    }
+
+    for (int i = 0; i < cycles; ++i) {
+        if (interrupted) {
+            interrupted = 0;
+            std::cout << "Interrupted" << std::endl;
+            stop();
+            return true;
+        }
+
+        // The instruction a breakpoint stopped on runs when resuming from it
+        const auto pc = chip8.get_program_counter();
+        if (!resumed && breakpoints[pc & 0x0FFF]) {
+            std::cout << "Breakpoint at 0x" << hex(pc, 3) << std::endl;
+            stop();
+            return true;
+        }
+        resumed = false;
+
+        execute();
+        if (paused) {
+            stop();
+            return true;
+        }
+    }
+    return true;
+}
+
+void Debugger::stop() {
+    paused = true;
+    steps = 0;
+    return_depth = -1;
+    print_registers();
+    print_listing(chip8.get_program_counter());
+}
+
+Debugger::Action Debugger::prompt() {
+    if (!prompted) {
+        std::cout << "(chip8) " << std::flush;
+        prompted = true;
+    }
+
+    // Without a complete command this frame the main loop carries on handling window events
+    std::string line;
+    if (!read_line(line)) { return input_closed ? Action::Quit : Action::Stay; }
+    prompted = false;
+
+    const auto action = command(line);
+    if (action == Action::Resume) { interrupted = 0; }
+    return action;
+}
+
+bool Debugger::read_line(std::string& line) {
+    // Take whatever the terminal has ready until a full line has arrived
+    while (input.find('\n') == std::string::npos && !input_closed) {
+        pollfd terminal{STDIN_FILENO, POLLIN, 0};
+        if (poll(&terminal, 1, 0) <= 0) { break; }
+
+        char chunk[256];
+        const auto count = read(STDIN_FILENO, chunk, sizeof(chunk));
+        if (count < 0 && errno == EINTR) { break; }
+        if (count <= 0) {
+            input_closed = true;
+            break;
+        }
+        input.append(chunk, count);
+    }
+
+    // A final line without a newline still counts once input has ended
+    auto end = input.find('\n');
+    if (end == std::string::npos) {
+        if (!input_closed || input.empty()) { return false; }
+        end = input.size();
+    }
+
+    line = input.substr(0, end);
+    input.erase(0, end + 1);
+    return true;
+}
+
+Debugger::Action Debugger::command(const std::string& line) {
+    std::istringstream stream(line);
+    std::string name;
+    stream >> name;
+    if (name.empty()) { return Action::Stay; }
+
+    if (name == "c" || name == "continue") { return Action::Resume; }
+
+    if (name == "s" || name == "step") {
+        std::string token;
+        std::uint16_t count = 1;
+        stream >> token;
+        if ((!token.empty() && !parse_hex(token, count)) || count == 0) {
+            std::cout << "Invalid count: " << token << std::endl;
+            return Action::Stay;
+        }
+        steps = count;
+        return Action::Resume;
+    }
+
+    if (name == "n" || name == "next") {
+        // Run through calls until they return here, anything else is a single step
+        if ((opcode_at(chip8.get_program_counter()) & 0xF000) == 0x2000) {
+            return_depth = chip8.get_stack_pointer();
+            return_pc = chip8.get_program_counter() + 2;
+        } else {
+            steps = 1;
+        }
+        return Action::Resume;
+    }
+
+    if (name == "f" || name == "finish") {
+        if (chip8.get_stack_pointer() == 0) {
+            std::cout << "Not inside a subroutine" << std::endl;
+            return Action::Stay;
+        }
+        return_depth = chip8.get_stack_pointer() - 1;
+        return_pc = chip8.get_stack()[chip8.get_stack_pointer() - 1] + 2;
+        return Action::Resume;
+    }
+
+    if (name == "b" || name == "break") {
+        std::string token;
+        std::uint16_t address;
+        stream >> token;
+        if (!parse_hex(token, address) || address >= breakpoints.size()) {
+            std::cout << "Invalid address: " << token << std::endl;
+            return Action::Stay;
+        }
+        breakpoints.flip(address);
+        std::cout << "Breakpoint at 0x" << hex(address, 3)
+                  << (breakpoints[address] ? " set" : " removed") << std::endl;
+        return Action::Stay;
+    }
+
+    if (name == "w" || name == "watch") {
+        std::string token;
+        std::string length_token;
+        std::uint16_t address;
+        std::uint16_t length = 1;
+        stream >> token >> length_token;
+        if (!parse_hex(token, address) || address >= watchpoints.size() ||
+            (!length_token.empty() && !parse_hex(length_token, length))) {
+            std::cout << "Invalid watch: " << line << std::endl;
+            return Action::Stay;
+        }
+        for (int i = address; i < address + length && i < watchpoints.size(); ++i) {
+            watchpoints.flip(i);
+        }
+        print_points();
+        return Action::Stay;
+    }
+
+    if (name == "cond") {
+        Condition condition;
+        std::string value;
+        std::uint16_t current;
+        stream >> condition.reg >> condition.op >> value;
+        const auto& op = condition.op;
+        if (!read_register(condition.reg, current) || !parse_hex(value, condition.value) ||
+            (op != "==" && op != "!=" && op != "<" && op != "<=" && op != ">" && op != ">=")) {
+            std::cout << "Invalid condition: " << line << std::endl;
+            return Action::Stay;
+        }
+        conditions.push_back(condition);
+        condition_states.push_back(evaluate(condition));
+        print_points();
+        return Action::Stay;
+    }
+
+    if (name == "clear") {
+        breakpoints.reset();
+        watchpoints.reset();
+        conditions.clear();
+        condition_states.clear();
+        return Action::Stay;
+    }
+
+    if (name == "i" || name == "info") {
+        print_points();
+        return Action::Stay;
+    }
+
+    if (name == "r" || name == "regs") {
+        print_registers();
+        return Action::Stay;
+    }
+
+    if (name == "l" || name == "list") {
+        std::string token;
+        std::uint16_t address = chip8.get_program_counter();
+        stream >> token;
+        if (!token.empty() && !parse_hex(token, address)) {
+            std::cout << "Invalid address: " << token << std::endl;
+            return Action::Stay;
+        }
+        print_listing(address);
+        return Action::Stay;
+    }
+
+    if (name == "x") {
+        std::string token;
+        std::string length_token;
+        std::uint16_t address;
+        std::uint16_t length = 0x10;
+        stream >> token >> length_token;
+        if (!parse_hex(token, address) ||
+            (!length_token.empty() && !parse_hex(length_token, length))) {
+            std::cout << "Invalid dump: " << line << std::endl;
+            return Action::Stay;
+        }
+        print_memory(address, length);
+        return Action::Stay;
+    }
+
+    if (name == "q" || name == "quit") { return Action::Quit; }
+
+    if (name != "h" && name != "help") { std::cout << "Unknown command: " << name << std::endl; }
+    std::cout << help;
+    return Action::Stay;
+}
+
+void Debugger::execute() {
+    // Decide before executing whether this instruction writes watched memory
+    std::uint16_t address;
+    const auto watched = written_watch(address);
+    const auto previous = chip8.get_memory()[address & 0x0FFF];
+
+    // A failing cycle leaves the core untouched, so stop where it can still be inspected
+    const auto pc = chip8.get_program_counter();
+    halted = !chip8.emulate_cycle();
+    if (halted) {
+        paused = true;
+        std::cout << "Halted on 0x" << hex(opcode_at(pc), 4) << " at 0x" << hex(pc, 3) << std::endl;
+        return;
+    }
+
+    if (--cycles_until_tick == 0) {
+        chip8.decrement_timers();
+        cycles_until_tick = cycles_per_tick;
+    }
+
+    if (watched) {
+        paused = true;
+        std::cout << "Watchpoint at 0x" << hex(address, 3) << ": 0x" << hex(previous, 2)
+                  << " -> 0x" << hex(chip8.get_memory()[address], 2) << std::endl;
+    }
+
+    for (int i = 0; i < conditions.size(); ++i) {
+        const auto met = evaluate(conditions[i]);
+        if (met && !condition_states[i]) {
+            paused = true;
+            std::cout << "Condition met: " << conditions[i].reg << " " << conditions[i].op
+                      << " 0x" << hex(conditions[i].value, 2) << std::endl;
+        }
+        condition_states[i] = met;
+    }
+
+    if (steps > 0 && --steps == 0) { paused = true; }
+    if (return_depth == chip8.get_stack_pointer() && return_pc == chip8.get_program_counter()) {
+        paused = true;
+    }
+}
+
+std::uint16_t Debugger::opcode_at(std::uint16_t address) const {
+    return chip8.get_memory()[address & 0x0FFF] << 8 | chip8.get_memory()[(address + 1) & 0x0FFF];
+}
+
+bool Debugger::read_register(const std::string& reg, std::uint16_t& value) const {
+    if (reg.size() == 2 && (reg[0] == 'V' || reg[0] == 'v')) {
+        std::uint16_t index;
+        if (!parse_hex(reg.substr(1), index)) { return false; }
+        value = chip8.get_registers()[index];
+        return true;
+    }
+
+    if (reg == "I") {
+        value = chip8.get_address_register();
+    } else if (reg == "PC") {
+        value = chip8.get_program_counter();
+    } else if (reg == "SP") {
+        value = chip8.get_stack_pointer();
+    } else if (reg == "DT") {
+        value = chip8.get_delay_timer();
+    } else if (reg == "ST") {
+        value = chip8.get_sound_timer();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool Debugger::evaluate(const Condition& condition) const {
+    std::uint16_t value;
+    read_register(condition.reg, value);
+
+    const auto& op = condition.op;
+    if (op == "==") { return value == condition.value; }
+    if (op == "!=") { return value != condition.value; }
+    if (op == "<") { return value < condition.value; }
+    if (op == "<=") { return value <= condition.value; }
+    if (op == ">") { return value > condition.value; }
+    return value >= condition.value;
+}
+
+bool Debugger::written_watch(std::uint16_t& address) const {
+    address = 0;
+    if (watchpoints.none()) { return false; }
+
+    // FX33 and FX55 are the only instructions that write memory, both starting at I
+    const auto opcode = opcode_at(chip8.get_program_counter());
+    int length;
+    if ((opcode & 0xF0FF) == 0xF033) {
+        length = 3;
+    } else if ((opcode & 0xF0FF) == 0xF055) {
+        length = ((opcode & 0x0F00) >> 8) + 1;
+    } else {
+        return false;
+    }
+
+    for (int i = 0; i < length; ++i) {
+        const auto target = (chip8.get_address_register() + i) & 0x0FFF;
+        if (watchpoints[target]) {
+            address = target;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Debugger::print_registers() const {
+    std::cout << "PC 0x" << hex(chip8.get_program_counter(), 3) << "  I 0x"
+              << hex(chip8.get_address_register(), 3) << "  SP " << +chip8.get_stack_pointer()
+              << "  DT 0x" << hex(chip8.get_delay_timer(), 2) << "  ST 0x"
+              << hex(chip8.get_sound_timer(), 2) << std::endl;
+
+    const auto& V = chip8.get_registers();
+    for (int i = 0; i < V.size(); ++i) {
+        std::cout << "V" << hex(i, 1) << " " << hex(V[i], 2) << (i == 0xF ? "\n" : "  ");
+    }
+
+    const auto& stack = chip8.get_stack();
+    const auto depth = chip8.get_stack_pointer();
+    if (depth > 0) {
+        std::cout << "Stack";
+        for (int i = 0; i < depth; ++i) { std::cout << " 0x" << hex(stack[i], 3); }
+        std::cout << std::endl;
+    }
+}
+
+void Debugger::print_listing(std::uint16_t address) const {
+    // Instructions are assumed to be aligned with the address being listed
+    const int start = address - 2 * list_length;
+    const int end = address + 2 * list_length;
+    for (int pc = start; pc <= end; pc += 2) {
+        if (pc < 0 || pc + 1 >= chip8.get_memory().size()) { continue; }
+        const auto opcode = opcode_at(pc);
+        std::cout << (pc == chip8.get_program_counter() ? "=> " : "   ")
+                  << (breakpoints[pc] ? "* " : "  ") << hex(pc, 3) << "  " << hex(opcode, 4) << "  "
+                  << disassemble(opcode) << std::endl;
+    }
+}
+
+void Debugger::print_memory(std::uint16_t address, int length) const {
+    for (int i = 0; i < length; ++i) {
+        const auto target = (address + i) & 0x0FFF;
+        if (i % 16 == 0) { std::cout << (i ? "\n" : "") << hex(target, 3) << " "; }
+        std::cout << " " << hex(chip8.get_memory()[target], 2);
+    }
+    std::cout << std::endl;
+}
+
+void Debugger::print_points() const {
+    for (int i = 0; i < breakpoints.size(); ++i) {
+        if (breakpoints[i]) { std::cout << "Breakpoint 0x" << hex(i, 3) << std::endl; }
+    }
+    for (int i = 0; i < watchpoints.size(); ++i) {
+        if (watchpoints[i]) { std::cout << "Watchpoint 0x" << hex(i, 3) << std::endl; }
+    }
+    for (const auto& condition : conditions) {
+        std::cout << "Condition " << condition.reg << " " << condition.op << " 0x"
+                  << hex(condition.value, 2) << std::endl;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef DEBUGGER_HPP
+#define DEBUGGER_HPP
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "chip8.hpp"
+
+// Terminal debugger that drives the core one instruction at a time between its own checks, so
+// the regular emulation loop carries no debugging overhead when it is not attached. It also ticks
+// the core's timers, so inspecting a paused program does not change its state
+class Debugger {
+public:
+    Debugger(Chip8& chip8, int cycles_per_tick);
+    ~Debugger();
+
+    // Emulate up to the given number of cycles, stopping early when paused. Returns false once
+    // the user quits
+    bool run(int cycles);
+    // Return whether emulation is stopped waiting for a command
+    inline auto is_paused() const { return paused; }
+    // Return whether the last cycle failed on an instruction the core cannot execute
+    inline auto is_halted() const { return halted; }
+
+private:
+    static const int list_length = 5;  // Instructions shown on either side of PC
+
+    enum class Action { Stay, Resume, Quit };
+
+    // Break when a register comparison becomes true
+    struct Condition {
+        std::string reg;
+        std::string op;
+        std::uint16_t value;
+    };
+
+    Chip8& chip8;
+
+    // Timers tick after every cycles_per_tick executed instructions, never while paused
+    const int cycles_per_tick;
+    int cycles_until_tick;
+
+    std::bitset<4096> breakpoints;  // PC breakpoints
+    std::bitset<4096> watchpoints;  // Memory write watchpoints
+    std::vector<Condition> conditions;
+    std::vector<bool> condition_states;  // Last result of each condition, for edge triggering
+
+    bool paused;
+    bool halted;
+    int steps;         // Instructions left to single-step, or zero
+    int return_depth;  // Stack depth that step-over and step-out wait to return to, or -1
+    std::uint16_t return_pc;
+
+    void (*previous_handler)(int);  // SIGINT handler restored on detach
+
+    // Terminal input, read without blocking so the window keeps responding while paused
+    std::string input;
+    bool input_closed;
+    bool prompted;
+
+    void stop();
+    Action prompt();
+    bool read_line(std::string& line);
+    Action command(const std::string& line);
+    void execute();
+
+    std::uint16_t opcode_at(std::uint16_t address) const;
+    bool read_register(const std::string& reg, std::uint16_t& value) const;
+    bool evaluate(const Condition& condition) const;
+    bool written_watch(std::uint16_t& address) const;
+
+    void print_registers() const;
+    void print_listing(std::uint16_t address) const;
+    void print_memory(std::uint16_t address, int length) const;
+    void print_points() const;
+};
+
+#endif  // DEBUGGER_HPP
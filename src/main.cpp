@@ -1,17 +1,21 @@
 #include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <thread>
 
 #include "chip8.hpp"
+#include "debugger.hpp"
 #include "platform.hpp"
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cout << "Usage: chip8 GAME " << std::endl;
+    const auto debug = argc == 3 && !std::strcmp(argv[1], "--debug");
+    if ((argc != 2 && !debug) || !std::strcmp(argv[argc - 1], "--debug")) {
+        std::cout << "Usage: chip8 [--debug] GAME " << std::endl;
         return 1;
     }
 
-    Chip8 chip8(argv[1]);
+    Chip8 chip8(argv[argc - 1]);
     Platform platform(Chip8::get_view_dimensions());
 
     // Emulation speed configuration
@@ -20,18 +24,31 @@ int main(int argc, char* argv[]) {
     const auto cycles_per_refresh = cycle_rate / refresh_rate;
     const auto nanos_per_refresh = std::chrono::nanoseconds(1000000000 / refresh_rate);
 
+    // Only attached on request so the regular loop below runs the core directly
+    std::unique_ptr<Debugger> debugger;
+    if (debug) { debugger.reset(new Debugger(chip8, cycles_per_refresh)); }
+
     auto running = true;
     while (running) {
         const auto start = std::chrono::high_resolution_clock::now();
 
         platform.handle_input(running, chip8.get_keypad());
-
-        for (int i = 0; i < cycles_per_refresh; ++i) { chip8.emulate_cycle(); }
+        if (!running) { break; }
+
+        if (debugger) {
+            // Ticks timers itself for the instructions it actually ran
+            if (!debugger->run(cycles_per_refresh)) { return debugger->is_halted() ? 1 : 0; }
+        } else {
+            for (int i = 0; i < cycles_per_refresh; ++i) {
+                if (!chip8.emulate_cycle()) { return 1; }
+            }
+            chip8.decrement_timers();
+        }
 
         platform.render(chip8.get_pixels());
 
-        chip8.decrement_timers();
-        if (chip8.get_sound_timer()) { platform.play_audio(); }
+        const auto paused = debugger && debugger->is_paused();
+        if (chip8.get_sound_timer() && !paused) { platform.play_audio(); }
 
         const auto end = std::chrono::high_resolution_clock::now();
         std::this_thread::sleep_for(nanos_per_refresh - (end - start));
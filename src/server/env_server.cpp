@@ -0,0 +1,452 @@
+#include "env_server.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::size_t receive_size = 65536;  // Most bytes read from one session per poll
+
+const std::size_t max_pending = 4096;    // Queued replies before a session's requests stop being read
+
+// Send what the socket will take, passing a file descriptor alongside the first byte if given
+ssize_t send_with_fd(int fd, const void* data, std::size_t size, int passed_fd) {
+    iovec iov{const_cast<void*>(data), size};
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+
+    char control[CMSG_SPACE(sizeof(int))];
+    if (passed_fd >= 0) {
+        std::memset(control, 0, sizeof(control));
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        auto header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(header), &passed_fd, sizeof(int));
+    }
+
+    return sendmsg(fd, &message, MSG_NOSIGNAL);
+}
+
+// Copy a fixed-size request struct out of the front of a payload
+template <typename T>
+bool parse(const std::vector<std::uint8_t>& payload, T& request) {
+    if (payload.size() < sizeof(T)) { return false; }
+    std::memcpy(&request, payload.data(), sizeof(T));
+    return true;
+}
+
+protocol::Reply reply(std::int32_t status, std::uint32_t value = 0) { return {status, value}; }
+
+}  // namespace
+
+EnvServer::EnvServer(const char* socket_path) : socket_path{socket_path}, listen_fd{-1} {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (this->socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path is too long: " << socket_path << std::endl;
+        std::exit(1);
+    }
+    std::strcpy(address.sun_path, socket_path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+        std::exit(1);
+    }
+
+    // Replace a socket left behind by a previous run
+    unlink(socket_path);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ||
+        listen(listen_fd, SOMAXCONN)) {
+        std::cerr << "Failed to listen on " << socket_path << ": " << std::strerror(errno)
+                  << std::endl;
+        close(listen_fd);
+        std::exit(1);
+    }
+}
+
+EnvServer::~EnvServer() {
+    for (auto& session : sessions) { close_session(session); }
+    close(listen_fd);
+    unlink(socket_path.c_str());
+}
+
+void EnvServer::run() {
+    std::vector<pollfd> fds;
+    while (true) {
+        // Listening socket first, followed by one entry per session in the same order
+        fds.clear();
+        fds.push_back({listen_fd, POLLIN, 0});
+        for (const auto& session : sessions) {
+            // Stop reading from clients that leave too many replies unread
+            short events = session.pending.size() < max_pending ? POLLIN : 0;
+            if (!session.pending.empty()) { events |= POLLOUT; }
+            fds.push_back({session.fd, events, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) { continue; }
+            std::cerr << "Failed to poll sockets: " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        for (int i = 1; i < fds.size(); ++i) {
+            auto& session = sessions[i - 1];
+            const auto events = fds[i].revents;
+            auto alive = true;
+            if (events & POLLOUT) { alive = flush(session); }
+            if (alive && (events & (POLLIN | POLLHUP | POLLERR))) { alive = receive(session); }
+            if (!alive) { close_session(session); }
+        }
+
+        // Drop sessions closed above before new ones are appended
+        sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+                                      [](const Session& session) { return session.fd < 0; }),
+                       sessions.end());
+
+        if (fds[0].revents & POLLIN) { accept_session(); }
+    }
+}
+
+void EnvServer::accept_session() {
+    const auto fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        std::cerr << "Failed to accept connection: " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    // Sessions share one thread, so none of them may block it on a partial request
+    const auto flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        std::cerr << "Failed to make connection non-blocking: " << std::strerror(errno)
+                  << std::endl;
+        close(fd);
+        return;
+    }
+    sessions.push_back({fd, {}, {}, {}, 0, nullptr, 0, 0, 0, {}, 0});
+}
+
+void EnvServer::close_session(Session& session) {
+    if (session.ring) { munmap(session.ring, session.ring_size); }
+    if (session.fd >= 0) { close(session.fd); }
+    for (const auto& pending : session.pending) {
+        if (pending.fd >= 0) { close(pending.fd); }
+    }
+    session.pending.clear();
+    session.ring = nullptr;
+    session.fd = -1;
+}
+
+bool EnvServer::receive(Session& session) {
+    // Take whatever has arrived, requests may span several reads
+    std::uint8_t chunk[receive_size];
+    const auto count = recv(session.fd, chunk, sizeof(chunk), 0);
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) { return true; }
+    if (count <= 0) { return false; }
+    session.received.insert(session.received.end(), chunk, chunk + count);
+
+    // Dispatch every request whose header and payload have both arrived
+    std::size_t offset = 0;
+    while (session.received.size() - offset >= sizeof(protocol::RequestHeader)) {
+        protocol::RequestHeader header;
+        std::memcpy(&header, session.received.data() + offset, sizeof(header));
+        if (header.length > protocol::max_payload) { return false; }
+
+        const auto start = offset + sizeof(header);
+        if (session.received.size() - start < header.length) { break; }
+
+        const std::vector<std::uint8_t> payload(session.received.begin() + start,
+                                                session.received.begin() + start + header.length);
+        offset = start + header.length;
+        handle_request(session, header, payload);
+    }
+    session.received.erase(session.received.begin(), session.received.begin() + offset);
+
+    // Send replies right away, whatever the socket cannot take waits for POLLOUT
+    return flush(session);
+}
+
+bool EnvServer::flush(Session& session) {
+    while (!session.pending.empty()) {
+        auto& front = session.pending.front();
+        const auto bytes = reinterpret_cast<const std::uint8_t*>(&front.reply);
+        const auto count =
+            send_with_fd(session.fd, bytes + session.pending_sent,
+                         sizeof(front.reply) - session.pending_sent,
+                         session.pending_sent == 0 ? front.fd : -1);
+        if (count < 0) { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+
+        session.pending_sent += count;
+        if (session.pending_sent < sizeof(front.reply)) { continue; }
+        if (front.fd >= 0) { close(front.fd); }
+        session.pending.pop_front();
+        session.pending_sent = 0;
+    }
+    return true;
+}
+
+void EnvServer::handle_request(Session& session, const protocol::RequestHeader& header,
+                               const std::vector<std::uint8_t>& payload) {
+    // Open passes the ring descriptor back alongside its reply, everything else needs a ring
+    auto ring_fd = -1;
+    protocol::Reply result;
+    if (header.type != protocol::Open && !session.ring) {
+        result = reply(protocol::NotOpen);
+    } else {
+        switch (header.type) {
+            case protocol::Open: {
+                result = open(session, payload, ring_fd);
+                break;
+            }
+
+            case protocol::Reset: {
+                result = reset(session, payload);
+                break;
+            }
+
+            case protocol::Step: {
+                result = step(session, payload);
+                break;
+            }
+
+            case protocol::Clone: {
+                result = clone(session, payload);
+                break;
+            }
+
+            case protocol::Restore: {
+                result = restore(session, payload);
+                break;
+            }
+
+            case protocol::Release: {
+                result = release(session, payload);
+                break;
+            }
+
+            default: {
+                result = reply(protocol::BadRequest);
+                break;
+            }
+        }
+    }
+
+    session.pending.push_back({result, ring_fd});
+}
+
+protocol::Reply EnvServer::open(Session& session, const std::vector<std::uint8_t>& payload,
+                                int& ring_fd) {
+    protocol::OpenRequest request;
+    if (!parse(payload, request) || session.ring) { return reply(protocol::BadRequest); }
+    if (request.envs == 0 || request.envs > protocol::max_envs || request.slots == 0 ||
+        request.slots > protocol::max_slots) {
+        return reply(protocol::BadRequest);
+    }
+
+    // Create shared memory reachable only through the descriptor handed to the client
+    const auto name =
+        "/chip8-server-" + std::to_string(getpid()) + "-" + std::to_string(session.fd);
+    const auto fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        std::cerr << "Failed to create shared memory: " << std::strerror(errno) << std::endl;
+        return reply(protocol::BadRequest);
+    }
+    shm_unlink(name.c_str());
+
+    const auto size = sizeof(protocol::RingHeader) +
+                      sizeof(protocol::Observation) * request.envs * request.slots;
+    void* ring = MAP_FAILED;
+    if (!ftruncate(fd, size)) {
+        ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (ring == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return reply(protocol::BadRequest);
+    }
+
+    session.ring = static_cast<std::uint8_t*>(ring);
+    session.ring_size = size;
+    session.slots = request.slots;
+    session.next_slot = 0;
+    session.envs.assign(request.envs, Env{Chip8(), {}, 0, 0, false, true});
+
+    protocol::RingHeader ring_header{request.envs, request.slots, sizeof(protocol::Observation), 0};
+    std::memcpy(session.ring, &ring_header, sizeof(ring_header));
+
+    ring_fd = fd;
+    return reply(protocol::Ok, size);
+}
+
+protocol::Reply EnvServer::reset(Session& session, const std::vector<std::uint8_t>& payload) {
+    protocol::ResetRequest request;
+    if (!parse(payload, request) || request.watch_count > protocol::max_watches) {
+        return reply(protocol::BadRequest);
+    }
+    if (request.env >= session.envs.size()) { return reply(protocol::BadEnv); }
+    for (int i = 0; i < request.watch_count; ++i) {
+        if (request.watches[i] >= protocol::memory_size) { return reply(protocol::BadRequest); }
+    }
+
+    // Game path makes up the rest of the payload
+    const std::string game(payload.begin() + sizeof(request), payload.end());
+    if (game.empty()) { return reply(protocol::BadRequest); }
+
+    // Load each game once, resets copy the pristine core unless the file has since changed
+    struct stat info;
+    if (stat(game.c_str(), &info)) {
+        std::cerr << "Could not open game file: " << game << std::endl;
+        games.erase(game);
+        return reply(protocol::LoadFailed);
+    }
+    auto iter = games.find(game);
+    if (iter == games.end() || iter->second.modified.tv_sec != info.st_mtim.tv_sec ||
+        iter->second.modified.tv_nsec != info.st_mtim.tv_nsec ||
+        iter->second.size != info.st_size) {
+        Chip8 core;
+        if (!core.load(game.c_str())) { return reply(protocol::LoadFailed); }
+        games.erase(game);
+        iter = games.emplace(game, Game{core, info.st_mtim, info.st_size}).first;
+    }
+
+    auto& env = session.envs[request.env];
+    env.core = iter->second.core;
+    env.core.seed(request.seed);
+    env.watch_count = request.watch_count;
+    std::copy(request.watches, request.watches + protocol::max_watches, env.watches.begin());
+    env.frame = 0;
+    env.loaded = true;
+    env.done = false;
+
+    return reply(protocol::Ok, publish_slot(session));
+}
+
+protocol::Reply EnvServer::step(Session& session, const std::vector<std::uint8_t>& payload) {
+    protocol::StepRequest request;
+    if (!parse(payload, request) || request.frames > protocol::max_frames ||
+        request.count != session.envs.size() ||
+        payload.size() != sizeof(request) + request.count * sizeof(std::uint16_t)) {
+        return reply(protocol::BadRequest);
+    }
+
+    for (int i = 0; i < session.envs.size(); ++i) {
+        auto& env = session.envs[i];
+        if (env.done) { continue; }
+
+        // Hold the masked keys down for every frame of this step
+        std::uint16_t mask;
+        std::memcpy(&mask, payload.data() + sizeof(request) + i * sizeof(mask), sizeof(mask));
+        auto& keypad = env.core.get_keypad();
+        for (int key = 0; key < keypad.size(); ++key) { keypad[key] = (mask >> key) & 1; }
+
+        for (std::uint32_t frame = 0; frame < request.frames && !env.done; ++frame) {
+            run_frame(env);
+        }
+    }
+
+    return reply(protocol::Ok, publish_slot(session));
+}
+
+protocol::Reply EnvServer::clone(Session& session, const std::vector<std::uint8_t>& payload) {
+    protocol::CloneRequest request;
+    if (!parse(payload, request)) { return reply(protocol::BadRequest); }
+    if (request.env >= session.envs.size()) { return reply(protocol::BadEnv); }
+    if (!session.envs[request.env].loaded) { return reply(protocol::NotLoaded); }
+    if (session.snapshots.size() >= protocol::max_snapshots) { return reply(protocol::BadRequest); }
+
+    const auto snapshot = session.next_snapshot++;
+    session.snapshots.emplace(snapshot, session.envs[request.env]);
+    return reply(protocol::Ok, snapshot);
+}
+
+protocol::Reply EnvServer::restore(Session& session, const std::vector<std::uint8_t>& payload) {
+    protocol::RestoreRequest request;
+    if (!parse(payload, request)) { return reply(protocol::BadRequest); }
+    if (request.env >= session.envs.size()) { return reply(protocol::BadEnv); }
+
+    const auto iter = session.snapshots.find(request.snapshot);
+    if (iter == session.snapshots.end()) { return reply(protocol::BadSnapshot); }
+
+    // Snapshots may be restored into any env of the session, and more than once
+    session.envs[request.env] = iter->second;
+    return reply(protocol::Ok, publish_slot(session));
+}
+
+protocol::Reply EnvServer::release(Session& session, const std::vector<std::uint8_t>& payload) {
+    protocol::ReleaseRequest request;
+    if (!parse(payload, request)) { return reply(protocol::BadRequest); }
+    if (!session.snapshots.erase(request.snapshot)) { return reply(protocol::BadSnapshot); }
+    return reply(protocol::Ok);
+}
+
+void EnvServer::run_frame(Env& env) {
+    for (int i = 0; i < cycles_per_frame; ++i) {
+        if (!env.core.emulate_cycle()) {
+            env.done = true;
+            return;
+        }
+    }
+    env.core.decrement_timers();
+    ++env.frame;
+
+    // Games commonly finish by jumping to themselves forever
+    const auto& memory = env.core.get_memory();
+    const auto pc = env.core.get_program_counter();
+    if (pc + 1 >= memory.size()) {
+        env.done = true;
+        return;
+    }
+    const auto opcode = memory[pc] << 8 | memory[pc + 1];
+    if (opcode == (0x1000 | pc)) { env.done = true; }
+}
+
+void EnvServer::observe(const Env& env, protocol::Observation& observation) {
+    std::memset(&observation, 0, sizeof(observation));
+    observation.frame = env.frame;
+    observation.done = env.done;
+    if (!env.loaded) { return; }
+
+    // Pack one byte per pixel down to one bit per pixel
+    const auto pixels = env.core.get_pixels();
+    for (int i = 0; i < sizeof(observation.framebuffer); ++i) {
+        std::uint8_t byte = 0;
+        for (int bit = 0; bit < 8; ++bit) { byte = (byte << 1) | (pixels[i * 8 + bit] ? 1 : 0); }
+        observation.framebuffer[i] = byte;
+    }
+
+    const auto& memory = env.core.get_memory();
+    for (int i = 0; i < env.watch_count; ++i) {
+        observation.watches[i] = memory[env.watches[i]];
+    }
+    observation.sound = env.core.get_sound_timer() > 0;
+}
+
+std::uint32_t EnvServer::publish_slot(Session& session) {
+    const auto slot = session.next_slot;
+    session.next_slot = (session.next_slot + 1) % session.slots;
+
+    auto observations = reinterpret_cast<protocol::Observation*>(
+        session.ring + sizeof(protocol::RingHeader) +
+        sizeof(protocol::Observation) * session.envs.size() * slot);
+    for (int i = 0; i < session.envs.size(); ++i) { observe(session.envs[i], observations[i]); }
+
+    return slot;
+}
@@ -0,0 +1,95 @@
+#ifndef ENV_SERVER_HPP
+#define ENV_SERVER_HPP
+
+#include <sys/types.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../chip8.hpp"
+#include "protocol.hpp"
+
+// Serves batches of emulators to training clients over a Unix domain socket, delivering
+// observations through a shared memory ring owned by each session
+class EnvServer {
+public:
+    EnvServer(const char* socket_path);
+    ~EnvServer();
+
+    void run();
+
+private:
+    static const int cycles_per_frame = 540 / 60;  // Same clock and refresh rate as the player
+
+    struct Env {
+        Chip8 core;
+        std::array<std::uint16_t, protocol::max_watches> watches;
+        std::uint32_t watch_count;
+        std::uint32_t frame;
+        bool loaded;
+        bool done;
+    };
+
+    // Freshly loaded core, reloaded when the file on disk changes
+    struct Game {
+        Chip8 core;
+        timespec modified;
+        off_t size;
+    };
+
+    // Reply waiting for the client to drain its socket, Open also passes the ring descriptor
+    struct Pending {
+        protocol::Reply reply;
+        int fd;
+    };
+
+    struct Session {
+        int fd;
+        std::vector<std::uint8_t> received;  // Bytes of requests not yet complete
+        std::vector<Env> envs;
+        std::unordered_map<std::uint32_t, Env> snapshots;
+        std::uint32_t next_snapshot;
+
+        // Observation ring
+        std::uint8_t* ring;
+        std::size_t ring_size;
+        std::uint32_t slots;
+        std::uint32_t next_slot;
+
+        // Replies not yet fully sent
+        std::deque<Pending> pending;
+        std::size_t pending_sent;  // Bytes of the front reply already sent
+    };
+
+    const std::string socket_path;
+    int listen_fd;
+
+    std::vector<Session> sessions;
+    std::unordered_map<std::string, Game> games;  // Keyed by game path
+
+    void accept_session();
+    void close_session(Session& session);
+    bool receive(Session& session);
+    bool flush(Session& session);
+    void handle_request(Session& session, const protocol::RequestHeader& header,
+                        const std::vector<std::uint8_t>& payload);
+
+    protocol::Reply open(Session& session, const std::vector<std::uint8_t>& payload, int& ring_fd);
+    protocol::Reply reset(Session& session, const std::vector<std::uint8_t>& payload);
+    protocol::Reply step(Session& session, const std::vector<std::uint8_t>& payload);
+    protocol::Reply clone(Session& session, const std::vector<std::uint8_t>& payload);
+    protocol::Reply restore(Session& session, const std::vector<std::uint8_t>& payload);
+    protocol::Reply release(Session& session, const std::vector<std::uint8_t>& payload);
+
+    void run_frame(Env& env);
+    void observe(const Env& env, protocol::Observation& observation);
+    std::uint32_t publish_slot(Session& session);
+};
+
+#endif  // ENV_SERVER_HPP
@@ -0,0 +1,15 @@
+#include <iostream>
+
+#include "env_server.hpp"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: chip8-server SOCKET " << std::endl;
+        return 1;
+    }
+
+    EnvServer server(argv[1]);
+    server.run();
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstdint>
+
+// Wire protocol shared by the environment server and its clients. Every request is a
+// RequestHeader followed by `length` bytes of payload, every request is answered with a single
+// Reply. All fields are in host byte order since both ends live on the same machine.
+namespace protocol {
+
+const std::uint32_t max_envs = 1024;       // Environments per session
+const std::uint32_t max_slots = 64;        // Observation slots per session ring
+const std::uint32_t max_snapshots = 1024;  // Unreleased snapshots per session
+const std::uint32_t max_watches = 16;      // Memory addresses reported with each observation
+const std::uint32_t max_payload = 4096;    // Largest accepted request payload
+const std::uint32_t max_frames = 600;      // Frames per step, bounds how long a request takes
+const std::uint32_t memory_size = 4096;    // Watched addresses must lie below this
+
+enum MessageType : std::uint32_t {
+    Open = 1,     // OpenRequest, creates the session and replies with the ring descriptor
+    Reset = 2,    // ResetRequest followed by the game path, replies with a ring slot
+    Step = 3,     // StepRequest followed by one keypad mask per env, replies with a ring slot
+    Clone = 4,    // CloneRequest, replies with a snapshot id or BadRequest past max_snapshots
+    Restore = 5,  // RestoreRequest, replies with a ring slot
+    Release = 6   // ReleaseRequest, replies with zero
+};
+
+enum Status : std::int32_t {
+    Ok = 0,
+    BadRequest = -1,   // Unknown type or malformed payload
+    NotOpen = -2,      // Session has not been opened yet
+    BadEnv = -3,       // Env index out of range
+    LoadFailed = -4,   // Game file could not be loaded
+    BadSnapshot = -5,  // Snapshot id does not exist
+    NotLoaded = -6     // Env has not been reset with a game yet, so there is nothing to clone
+};
+
+struct RequestHeader {
+    std::uint32_t type;
+    std::uint32_t length;
+};
+
+struct Reply {
+    std::int32_t status;
+    std::uint32_t value;  // Ring slot, snapshot id or zero depending on request
+};
+
+struct OpenRequest {
+    std::uint32_t envs;   // Number of environments stepped together
+    std::uint32_t slots;  // Number of observation slots in the ring
+};
+
+struct ResetRequest {
+    std::uint32_t env;
+    std::uint32_t seed;                   // Seed for CXKK randomness
+    std::uint32_t watch_count;            // Number of valid entries in watches
+    std::uint16_t watches[max_watches];   // Memory addresses copied into each observation
+};
+
+struct StepRequest {
+    std::uint32_t frames;  // Frames to run, keypad masks are held for all of them
+    std::uint32_t count;   // Number of keypad masks that follow, must match session envs
+};
+
+struct CloneRequest {
+    std::uint32_t env;
+};
+
+struct RestoreRequest {
+    std::uint32_t env;
+    std::uint32_t snapshot;
+};
+
+struct ReleaseRequest {
+    std::uint32_t snapshot;
+};
+
+// Shared memory layout: a RingHeader followed by `slots` slots of `envs` Observations each.
+// Reset, Step and Restore each write every env's observation into the next slot and reply with
+// its index. A slot stays valid until `slots` further Reset, Step or Restore requests have been
+// made on the same session, Clone and Release do not advance the ring.
+struct RingHeader {
+    std::uint32_t envs;
+    std::uint32_t slots;
+    std::uint32_t observation_size;
+    std::uint32_t reserved;
+};
+
+struct Observation {
+    std::uint8_t framebuffer[64 * 32 / 8];  // One bit per pixel, rows top to bottom, MSB first
+    std::uint8_t watches[max_watches];      // Memory bytes at the addresses given on reset
+    std::uint32_t frame;                    // Frames run since the last reset
+    std::uint8_t done;                      // Set once the game halts or spins on a self jump
+    std::uint8_t sound;                     // Set while the sound timer is active
+    std::uint8_t reserved[2];
+};
+
+}  // namespace protocol
+
+#endif  // PROTOCOL_HPP